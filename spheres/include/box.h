@@ -20,13 +20,21 @@
 
 
 #include <vector>
+#include <functional>
 #include <math.h>
 
 #include "vector.h"
 #include "grid_field.h"
+#include "cell_list.h"
+#include "stencil.h"
 #include "event.h"
 #include "sphere.h"
+#include "sphere_store.h"
 #include "heap.h"
+#include "calendar.h"
+#include "random.h"
+#include "predictor.h"
+#include "neighbor_list.h"
 
 
 #define PI     3.141592653589793238462643
@@ -34,68 +42,205 @@
 #define VOLUMESPHERE pow(PI,((double)(DIM))/2.)/exp(lgamma(1+((double)(DIM))/2.)) // volume prefactor for sphere
 #define DBL_EPSILON  2.2204460492503131e-016 // smallest # such that 1.0+DBL_EPSILON!=1.0
 #define M 1.0
+#define MAXTRIES 1000000      // random positions tried per sphere in CreateSphere
+
+#ifdef CALENDAR_QUEUE         // make QUEUE=calendar
+typedef calendar eventqueue;
+#else
+typedef heap eventqueue;
+#endif
 
 
 //---------------------------------------------------------------------------
-// Class neighbor
+// Class neighbor: base of the operations passed to box::ForAllNeighbors,
+// which call Operation(int j, const vector<DIM, int>& pboffset)
 //---------------------------------------------------------------------------
 class neighbor
 {
 public:
     neighbor(int i_i);
 
-    virtual void Operation(int j, vector<DIM, int>& pboffset) = 0;
-
     int i;
 };
 
 
 //---------------------------------------------------------------------------
-// Class box
+// Class box: one packing, processed one event at a time in time order.
+// Events of different spheres are only independent when no chain of
+// collisions links them, and with hard spheres such a chain can cross
+// any distance in any short time, so the event loop stays serial. A box
+// uses several threads only in PredictAll; several packings run side by
+// side on the threadpool of ensemble.h.
 //---------------------------------------------------------------------------
 class box
 {
 public:
     // constructor and destructor
-    box(int N_i, double r_i, double growthrate_i, double maxpf_i);
+    box(int N_i, double r_i, double growthrate_i, double maxpf_i, uint64_t seed_i, double cellwidth_i,
+        double skin_i, bool lazy_i, int nthreads_i, double growthcontrol_i);
+    /**
+     * seed_i == 0 draws a seed from std::random_device, the seed actually used is kept in seed;
+     * cellwidth_i == 0 keeps the grid of Optimalngrids(maxpf) for the whole run, otherwise
+     * the grid follows the current radius, see ChangeNgrids;
+     * skin_i == 0 finds collisions in the neighbor cells and moves spheres between cells
+     * with transfers, otherwise on neighbour lists with a skin of skin_i diameters;
+     * lazy_i keeps two event slots per sphere, see ProcessLazyEvent, with cells only;
+     * PredictAll runs on nthreads_i threads;
+     * growthcontrol_i > 0 adapts growthrate_i at every Synchronize(true), see AdaptGrowthRate;
+     */
     ~box();
 
     // Creating configurations
     int Optimalngrids(double maxpf);
+    int Optimalngrids2(double currentradius);
+    /**
+     * cells of cellwidth diameters at currentradius, at least 1;
+     */
+    void ChangeNgrids(int newngrids);
+    /**
+     * brings all spheres to gtime, rebuilds cells and stencil for newngrids
+     * in one pass over the spheres and then PredictAll();
+     * with a skin the cells hold the centres nl.X, the lists stay;
+     * sets outgrowtime;
+     */
     void CreateSpheres(double temp);
+    /**
+     * random sequential addition of N spheres of radius r with CreateSphere,
+     * up to about pf 0.35;
+     */
     void CreateSphere(int Ncurrent);   
+    void CreateLattice(double temp);
+    /**
+     * N spheres of radius r on random sites of the smallest simple cubic
+     * lattice with N sites or more, each moved by up to a/2 - r along each
+     * axis for a spacing a, up to pf pi/6 when N is a cube;
+     */
     double Velocity(double temp);
-    void VelocityGiver(double temp);  
+    void VelocityGiver(double temp, bool zerodrift = true, bool exacttemp = true);
+    /**
+     * draws all N*DIM velocity components at once from the Maxwell-Boltzmann distribution;
+     * zerodrift: subtract the centre-of-mass velocity;
+     * exacttemp: rescale so that sum(M*v*v) equals temp per degree of freedom exactly;
+     */
     void SetInitialEvents();
+    /**
+     * queues every sphere and PredictAll(), instead of N checks at gtime;
+     */
     void RecreateSpheres(const char* filename, double temp);
-    void ReadPositions(const char* filename);
+    /**
+     * N spheres at the positions of a file of WriteConfiguration or WriteLAMMPS, keeping
+     * r if the spheres of the file are at least as large, and taking
+     * their radius otherwise;
+     */
+    double ReadPositions(const char* filename);
+    /**
+     * positions of a binary configuration, or of its LAMMPS text with
+     * lammps_data on nthreads threads;
+     * return:
+     * radius written in the file;
+     */
     void AssignCells();
+    void BuildNeighborLists();
+    /**
+     * bounding spheres around the positions at gtime for all spheres, cells
+     * of their centres, and the lists of all overlapping pairs;
+     */
+    void RebuildNeighborList(int i);
+    /**
+     * new bounding sphere around the position of i at gtime, x wrapped into
+     * the box, and the list of i built again from the neighbor cells;
+     */
+    vector<DIM, int> ListCell(const vector<DIM>& X);
+    /**
+     * cell of a bounding sphere centre X in the box;
+     */
 
-    void Process(int n);
+    bool Process(int n, double tstop = dblINF);
     /**
-     * repeat ProcessEvent() n times;
+     * repeat ProcessEvent() n times, or until the next event comes at or after tstop;
+     * ncollisions, ntransfers and nchecks then count the events of these n;
+     * return:
+     * true if it stopped at tstop, with gtime = tstop;
      */
     void ProcessEvent();
     /**
      * i = h.extractmax(), e = s[i].nextevent;
-     * if e.j == INF, which means check:
-     * s[i].nextevent = FindNextEvent(int i), downheap(1);
-     * if 0 <= e.j < N, which means collision between i and j:
+     * if e.time > outgrowtime, ChangeNgrids to fewer cells first;
+     * if e.kind == CHECK:
+     * s[i].nextevent = FindNextEvent(int i), h.update(i);
+     * if e.kind == COLLISION, which means collision between i and e.j:
      * Collision(e) then give i and j checks;
+     * if e.kind == EXPIRY:
+     * RebuildNeighborList(i) then give i its next event;
      * else, which means transfer:
      * Transfer(e) then give i check;
+     * the check scans all neighbor cells again, not only the new face:
+     * with one event per sphere, a neighbor whose trajectory or event
+     * changed since i was predicted need not have looked at i, so the
+     * collisions found in the cells i shares before and after the
+     * transfer can be stale or missing;
+     * with lazy, ProcessLazyEvent(i, e) after the outgrow check instead;
+     */
+    void ProcessLazyEvent(int i, event e);
+    /**
+     * ProcessEvent with two slots per sphere: tslot[i] holds the transfer
+     * and cslot[i] the collision or check of i, and s.nextevent(i) the
+     * earlier of them. Candidates are filtered by the collision slots, so
+     * that a collision slot does not depend on transfers and survives them;
+     * if e.kind == TRANSFER:
+     * Transfer(e), new tslot[i], PredictPair(i) over the new face of cells,
+     * or over all cells after crossing the periodic boundary;
+     * if e.kind == COLLISION:
+     * Collision(e), new tslot and PredictPair over all cells for i, then j;
+     * if e.kind == CHECK:
+     * new tslot if it was the check, PredictPair over all cells for i
+     * unless cslot[i] holds a collision;
+     */
+    void PredictPair(int i, const vector<DIM, int>& vl, const vector<DIM, int>& vr);
+    /**
+     * earliest collision of i with a sphere in the neighbor cells at
+     * offsets [vl, vr] that comes before both collision slots, Pair(c);
+     */
+    void Pair(event c);
+    /**
+     * Unpair(c.i), Unpair(c.j), c into cslot[c.i] and its mirror into cslot[c.j];
+     */
+    void Unpair(int i);
+    /**
+     * if cslot[i] is a collision, its partner's slot becomes a check;
+     */
+    event Earlier(int i);
+    /**
+     * the earlier of cslot[i] and tslot[i];
+     */
+    void PredictAll();
+    /**
+     * the next events of all spheres at once, as if every sphere had a
+     * check at gtime:
+     * the transfer or expiry of every sphere, then with those as filter the
+     * earliest collision of every sphere, both with ForAllSpheres;
+     * the collisions are then handed out by time, and ties by sphere, so a
+     * sphere whose partner already got an earlier collision gets a check
+     * at its own collision time instead;
+     * h.refresh() builds the queue in O(N);
+     */
+    void ForAllSpheres(const std::function<void(int, predictor&)>& op);
+    /**
+     * op(i, candidates) for all spheres, in nthreads blocks of spheres on
+     * their own threads with their own predictor; op may only write to
+     * what belongs to i;
      */
     event FindNextEvent(int i);
     /**
-     * t = FindNextTransfer(i);
-     * c = FindNextCollision(int i);
+     * t = FindNextTransfer(i), or FindNextExpiry(i) with a skin;
+     * c = FindNextCollision(i, batch);
      * if c.time < t.time, CollisionChecker(c), return c;
      * else, return t;
      */
     void CollisionChecker(event c);
     /**
      * if c.j's next event is collision with other sphere, set it as check since collision between i and j happens before that;
-     * set c.j's next event as c(c.time, j, i, c.v * (-1)), which is symmetric with c.i;
+     * set c.j's next event as c(c.time, j, i, c.image() * (-1)), which is symmetric with c.i;
      */
     event FindNextTransfer(int i);
     /**
@@ -103,28 +248,38 @@ public:
      * return:
      * an transfer event recording transfer time (ttime + gtime) and wall index
      */
-    event FindNextCollision(int i);
+    event FindNextExpiry(int i);
     /**
-     * collision cc(i, this);
-     * vl(all -1s), vr(all 1s);
-     * ForAllNeighbors(i, vl, vr, cc);
-     * cc.cpartner == i  --> no collisions --> return an event with INF time and check;
-     * else --> closest collision time cc.time with cc.cpartner, and stores its pboffset;
+     * time at which sphere i, growing, first touches the surface of its
+     * bounding sphere;
      */
-    void ForAllNeighbors(int i, vector<DIM, int> vl, vector<DIM,int> vr, neighbor& operation);
+    event EarliestCandidate(int i, predictor& candidates);
     /**
-     * for all neighbor cells of i ranging from vl(all -1s) to vr(all 1s), calculate pboffset;
-     * for all spheres in the cell, operation.Operation(j, pboffset),
-     * which actually is PredictCollision(i, j, pboffset, ctime, cpartner, cpartnerpboffset);
-     * ctime initialized as dbINF and cpartner initialized as i;
+     * candidates.earliest() for the candidates of i, as an event;
      */
-    void PredictCollision(int i, int j, vector<DIM, int> pboffset, double& ctime, int& cpartner, 
-                            vector<DIM, int>& cpartnerpboffset);
+    event FindNextCollision(int i, predictor& candidates);
     /**
-     * if j != i, 
-     * ctimej = CalculateCollision(i, j, pboffset.Double()) + gtime;
-     * if (ctimej < ctime) && (ctimej < s[j].nextevent.time)
-     * ctime = ctimej, cpartner = j; cpartnerpboffset = pboffset; 
+     * collision cc(i, this, candidates), batch for one sphere at a time;
+     * ForAllNeighbors(s.cell(i), cc) gathers every j != i into batch,
+     * or the spheres on the list of i with a skin;
+     * batch.earliest() --> -1 --> no collisions --> return an event with INF time and check;
+     * else --> earliest collision time with its candidate j, and j's pboffset;
+     */
+    template <class operation>
+    void ForAllNeighbors(const vector<DIM, int>& cell, operation& op);
+    /**
+     * for all 3^DIM neighbor cells of cell, with their pboffset, and all
+     * spheres j in them, op.Operation(j, pboffset); the cells and their
+     * pboffset come from stencil, and op.Operation is inlined into the loop;
+     * collision adds j to the candidates in batch, overlap is used by
+     * CreateSphere for a position that has no sphere yet.
+     */
+    template <class operation>
+    void ForAllNeighbors(const vector<DIM, int>& cell, const vector<DIM, int>& vl,
+                         const vector<DIM, int>& vr, operation& op);
+    /**
+     * the same for the neighbor cells at offsets vl[k] <= d[k] <= vr[k],
+     * vl[k] in -1, 0 and vr[k] in 0, 1, in the same order;
      */
     double CalculateCollision(int i, int j, vector<DIM> pboffset);
     /**
@@ -137,6 +292,8 @@ public:
      * return:
      * time of collision between i & j
      * INF if it will not happen.
+     * predictor::earliest does the same for a batch of j; this one
+     * reports what went wrong when the batch was suspect.
      */
     double QuadraticFormula(double a, double b, double c);
     /**
@@ -156,7 +313,7 @@ public:
     /**
      * gtime = e.time;
      * update position and lutime;
-     * calculate new cell beased on e.j, and pdateCell(e.i, new cell);
+     * calculate new cell beased on e.wall(), and pdateCell(e.i, new cell);
      */
     void UpdateCell(int i, vector<DIM,int>& celli);
     /**
@@ -170,6 +327,9 @@ public:
      * r += gtime*growthrate;
      * gtime = 0;
      * can change growth rate and recale velocity;
+     * with cellwidth > 0, ChangeNgrids if the current radius asks for another grid;
+     * otherwise PredictAll() after rescaling;
+     * with growthcontrol > 0 and rescale, AdaptGrowthRate for the cycle that ended;
      */
 
     // Debugging
@@ -181,18 +341,68 @@ public:
     // Statistics
     double Energy();
     double PackingFraction();  
+    void AdaptGrowthRate();
+    /**
+     * new growthrate after a cycle: at reduced pressure p the gap between
+     * neighbours is about r/p, and the rescaled spheres cross it in a time
+     * of about r/p, so growthrate = growthcontrol*r/p grows the spheres by
+     * growthcontrol gaps while the spheres cross one; the energy the
+     * growth put into the last cycle caps the rate, and it changes by at
+     * most a factor 2 per cycle; growthrate only changes at gtime = 0,
+     * where r stays, and outgrowtime follows it;
+     */
+    double PackingTime(double targetpf);
+    /**
+     * gtime at which the growing spheres reach packing fraction targetpf,
+     * dblINF if they don't grow;
+     */
     void PrintStatistics();
     void RunTime();
     void WriteConfiguration(const char* wconfigfile);
+    /**
+     * the spheres at gtime in the binary format of configuration.h;
+     */
+    void WriteLAMMPS(const char* lammpsfile);
+    /**
+     * the same as a LAMMPS data file, with r as the mass of the one type;
+     */
+
+    // Checkpoints
+    void WriteCheckpoint(const char* filename);
+    /**
+     * the whole state in binary, see checkpoint.h: spheres with their
+     * events, the order of the cell lists, the neighbour lists and the
+     * event queue; written to filename.tmp and then renamed, so filename
+     * always holds a whole checkpoint;
+     */
+    bool ReadCheckpoint(const char* filename);
+    /**
+     * the state of WriteCheckpoint from the mapped file, instead of
+     * creating spheres; the events, cells and queue come back as they
+     * were and nothing is predicted again, so the run goes on exactly
+     * as if it had not stopped; maxpf, cellwidth, growthcontrol and
+     * nthreads stay those of the constructor;
+     * return:
+     * false if filename cannot be opened; exits if it is not a
+     * checkpoint of N spheres with this lazy and skin;
+     */
 
     //variables
     const int N;                   // number of spheres
     int ngrids;                    // number of cells in one direction
+    double cellwidth;              // cell width in diameters at each regrid, 0 for a fixed grid
+    double skin;                   // neighbour-list skin in diameters, 0 for cell transfers
+    bool lazy;                     // two event slots per sphere
+    int nthreads;                  // threads of PredictAll
+    double growthcontrol;          // fraction of the gap to jamming grown per cycle, 0 for a fixed rate
+    double outgrowtime;            // gtime at which spheres grow wider than the cells
     double maxpf;
     double growthrate;             // growthrate of the spheres
     double r;                      // radius, defined at gtime = 0
     double gtime;                  // this is global clock
     double rtime;                  // reset time, total time = rtime + gtime
+    uint64_t seed;                 // seed of the random number generator
+    rng random;                    // random number generator of this box
 
     // statistics
     double pressure;               // pressure
@@ -203,34 +413,125 @@ public:
     int ncollisions;               // number of collisions
     int ntransfers;                // number of transfers
     int nchecks;                   // number of checks
+    int nexpiries;                 // number of neighbour-list expiries
     int neventstot;                // total number of events 
     int ncycles;                   // counts # cycles for output
 
     time_t start, error, end;      // run time of program
 
     // arrays
-    sphere *s;                      // array of spheres
-    grid_field<DIM, int> cells; // array that keeps track of spheres in each cell
-    int *binlist;                   // linked-list for cells array
-    heap h;                         // event heap
+    sphere_store s;                 // spheres, see sphere_store.h for the layout
+    cell_list<DIM> cells;           // spheres in each cell
+    stencil_table<DIM> stencil;     // neighbor cells of each cell, for ngrids
+    eventqueue h;                   // event heap, or calendar queue
+    predictor batch;                // collision candidates of one sphere
+    neighbor_list nl;               // bounding spheres and neighbour lists, with a skin
+    event *cslot;                   // collision or check of each sphere, if lazy
+    event *tslot;                   // transfer of each sphere, if lazy
     vector<DIM> *x;                 // positions of spheres.used for graphics
 };
 
 
 //---------------------------------------------------------------------------
-// Predicts collisions, inherits neighbor operation
+// Gathers collision candidates into a predictor, inherits neighbor operation
 //---------------------------------------------------------------------------
 class collision : public neighbor 
 {
 public:
-    collision(int i_i, box *b);
+    collision(int i_i, box *b, predictor& candidates_i);
+
+    void Operation(int j, const vector<DIM, int>& pboffset);
+
+    box *b; 
+    predictor& candidates;          // box::batch, or one per thread in PredictAll
+};
+
+
+//---------------------------------------------------------------------------
+// Checks a trial position for overlaps, inherits neighbor operation
+//---------------------------------------------------------------------------
+class overlap : public neighbor 
+{
+public:
+    overlap(int i_i, box *b, vector<DIM> x_i);
 
-    virtual void Operation(int j, vector<DIM, int>& pboffset);
+    void Operation(int j, const vector<DIM, int>& pboffset);
 
     box *b; 
-    double ctime;
-    int cpartner;
-    vector<DIM,int> cpartnerpboffset;
+    vector<DIM> x;                  // trial position of sphere i
+    bool found;                     // true once a sphere within 2r of x is seen
 };
 
+
+//---------------------------------------------------------------------------
+// Adds the spheres whose bounding spheres overlap that of i to the
+// neighbour lists, inherits neighbor operation
+//---------------------------------------------------------------------------
+class listbuilder : public neighbor
+{
+public:
+    listbuilder(int i_i, box *b, int jmin_i);
+
+    void Operation(int j, const vector<DIM, int>& pboffset);
+
+    box *b;
+    int jmin;                       // only j >= jmin, so a pass over all i adds each pair once
+};
+
+
+//---------------------------------------------------------------------------
+// Inline neighbor operations and traversal
+//---------------------------------------------------------------------------
+inline void collision::Operation(int j, const vector<DIM, int>& pboffset)
+{
+    if (j != i)
+        candidates.add(j, pboffset, b->s.x(j) + pboffset.Double()*SIZE, b->s.v(j), b->s.lutime(j),
+                     b->lazy ? b->cslot[j].time : b->s.nextevent(j).time);
+}
+
+inline void overlap::Operation(int j, const vector<DIM, int>& pboffset)
+{
+    if (found)
+        return;
+    vector<DIM> xj = b->s.x(j) + pboffset.Double()*SIZE;
+    if (vector<DIM>::norm_squared(x - xj) <= 4*b->r*b->r)
+        found = true;
+}
+
+inline void listbuilder::Operation(int j, const vector<DIM, int>& pboffset)
+{
+    if ((j == i) || (j < jmin))
+        return;
+    double reach = b->nl.rb[i] + b->nl.rb[j];
+    if (vector<DIM>::norm_squared(b->nl.X[i] - b->nl.X[j] - pboffset.Double()*SIZE) < reach*reach)
+        b->nl.add(i, j, pboffset);
+}
+
+template <class operation>
+inline void box::ForAllNeighbors(const vector<DIM, int>& cell, operation& op)
+{
+    int c = cells.flat(cell);
+    const stencil_table<DIM>::slot* slot = stencil.slots(cell);
+    for (int m = 0; m < stencil_table<DIM>::nslots; m++)
+        for (int j = cells.head(c + slot[m].delta); j != -1; j = cells.next(j))
+            op.Operation(j, slot[m].pboffset);
+}
+
+template <class operation>
+inline void box::ForAllNeighbors(const vector<DIM, int>& cell, const vector<DIM, int>& vl,
+                                 const vector<DIM, int>& vr, operation& op)
+{
+    int c = cells.flat(cell);
+    const stencil_table<DIM>::slot* slot = stencil.slots(cell);
+
+    int allowed = 0;                // the layers inside [vl, vr]
+    for (int k = 0; k < DIM; k++)
+        allowed |= ((vl.x[k] < 0) << (2*k)) | ((vr.x[k] > 0) << (2*k + 1));
+
+    for (int m = 0; m < stencil_table<DIM>::nslots; m++)
+        if ((stencil.sides(m) & ~allowed) == 0)
+            for (int j = cells.head(c + slot[m].delta); j != -1; j = cells.next(j))
+                op.Operation(j, slot[m].pboffset);
+}
+
 #endif 
@@ -0,0 +1,101 @@
+//---------------------------------------------------------------------------
+// Calendar queue of events, alternative to the event heap
+//---------------------------------------------------------------------------
+
+#ifndef  CALENDAR_H
+#define  CALENDAR_H
+
+#include "event.h"
+#include "sphere.h"
+#include "sphere_store.h"
+#include <ostream>
+
+#define CALENDARCHECK 64      // updates between checks of the bucket width
+#define CALENDARMEMORY 1024   // updates over which the lookahead is averaged
+
+//---------------------------------------------------------------------------
+// Calendar entry of one sphere, everything link and unlink touch
+//---------------------------------------------------------------------------
+class calendarnode
+{
+public:
+    double time;                    // event time, as queued
+    long long slot;                 // virtual bucket, floor(time/width)
+    int next;                       // later sphere in the same bucket
+    int prev;                       // earlier sphere in the same bucket, -1 at the head
+};
+
+//---------------------------------------------------------------------------
+// Class calendar: every sphere has one event, events are hashed by time
+// into nbuckets buckets of the given width (R. Brown, Comm. ACM 31, 1988).
+// A bucket is a time-sorted list linked through the spheres, so its head
+// is its earliest event. Spheres of all "years" share a bucket; the
+// virtual bucket slot = floor(time/width) tells them apart exactly.
+//---------------------------------------------------------------------------
+class calendar
+{
+public:
+    // constructor and destructor
+    calendar(int maxsize);
+    ~calendar();
+
+    // variables
+    int maxsize;   // max allowed number of events
+    int N;         // current number of events
+    sphere_store *s;
+
+    int nbuckets;                   // power of 2, at least maxsize
+    double width;                   // time spanned by one bucket
+    long long current;              // slot of the last extracted event
+    double now;                     // time of the last extracted event
+    int *head;                      // earliest sphere of each bucket, -1 if empty
+    calendarnode *a;                // entry of each sphere
+
+    // width adaptation
+    int nupdates;                   // updates since the last check of the width
+    double lookahead;               // decaying sum of (time - now) over the updates
+    double weight;                  // decaying number of updates in lookahead
+
+    // functions which operate on the calendar
+    void insert(int i);
+    void update(int i);
+    /**
+     * moves sphere i to the bucket of s[i].nextevent.time, which may be
+     * earlier or later than before;
+     */
+    int extractmax();
+    /**
+     * returns the sphere with the earliest event without removing it,
+     * like heap::extractmax; visits the buckets of the current year in
+     * order and falls back to a search over all bucket heads;
+     */
+    void refresh();
+    /**
+     * reloads every time from s and relinks all spheres;
+     */
+    static const char* kind();
+    void write(std::ostream& out) const;
+    /**
+     * the bucket width, its adaptation and the spheres bucket by bucket,
+     * for box::WriteCheckpoint;
+     */
+    bool read(const char* data, size_t size);
+    /**
+     * relinks the spheres of write into the same buckets in the same
+     * order, with their times from s, so events at equal times still
+     * come out in the order they would have;
+     * return:
+     * false if size bytes do not hold a queue of at most maxsize spheres;
+     */
+    void print();
+
+private:
+    void link(int i);
+    void unlink(int i);
+    void resize(double width_i);
+    /**
+     * relinks all spheres for a new bucket width;
+     */
+};
+
+#endif
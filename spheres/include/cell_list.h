@@ -0,0 +1,179 @@
+#ifndef CELL_LIST_H
+#define CELL_LIST_H
+
+#include "vector.h"
+
+// ======================================================================
+// cell_list
+// ======================================================================
+
+// The spheres in each cell of a D dimensional grid, as intrusive doubly
+// linked lists: one head per cell, and next/prev links per sphere in two
+// dense arrays. insert pushes at the head and remove unlinks in place,
+// both O(1) whatever the occupancy of the cell.
+
+template<int D>
+class cell_list {
+
+ public:
+  int ngrids;                   // number of cells in one direction
+  int ncells;                   // ngrids^D
+
+ private:
+  int* heads;                   // first sphere of each cell, -1 if empty
+  int* nexts;                   // next sphere in the same cell, -1 at the end
+  int* prevs;                   // previous sphere in the same cell, -1 at the head
+  int* cellof;                  // flat cell of each sphere, -1 if in none
+  int nspheres;
+  vector<D, int> offset;        // x[0] runs fastest, as in grid_field
+
+ public:
+
+  cell_list();
+  ~cell_list();
+
+  void set_size(const int ngrids_i, const int nspheres_i);  // empties all cells
+  int flat(const vector<D, int>&) const;
+
+  void insert(const int i, const vector<D, int>&);
+  void remove(const int i);
+  void move(const int i, const vector<D, int>&);
+  bool contains(const int i, const vector<D, int>&) const;
+
+  int head(const int c) const;                  // c = flat(cell)
+  int next(const int i) const;
+};
+
+
+// cell_list
+// ~~~~~~~~~
+template<int D>
+cell_list<D>::cell_list()
+  : ngrids(0), ncells(0), heads(0), nexts(0), prevs(0), cellof(0), nspheres(0)
+{
+}
+
+
+// ~cell_list
+// ~~~~~~~~~~
+template<int D>
+cell_list<D>::~cell_list()
+{
+  delete[] heads;
+  delete[] nexts;
+  delete[] prevs;
+  delete[] cellof;
+}
+
+
+// set_size
+// ~~~~~~~~
+template<int D>
+void cell_list<D>::set_size(const int ngrids_i, const int nspheres_i)
+{
+  delete[] heads;
+  delete[] nexts;
+  delete[] prevs;
+  delete[] cellof;
+
+  ngrids = ngrids_i;
+  nspheres = nspheres_i;
+  ncells = 1;
+  for(int k=0; k<D; k++) {
+    offset.x[k] = ncells;
+    ncells *= ngrids;
+  }
+
+  heads = new int[ncells];
+  nexts = new int[nspheres];
+  prevs = new int[nspheres];
+  cellof = new int[nspheres];
+  for(int c=0; c<ncells; c++)
+    heads[c] = -1;
+  for(int i=0; i<nspheres; i++)
+    cellof[i] = -1;
+}
+
+
+// flat
+// ~~~~
+template<int D>
+inline int cell_list<D>::flat(const vector<D, int>& cell) const
+{
+  int c = 0;
+  for(int k=0; k<D; k++)
+    c += cell.x[k]*offset.x[k];
+
+  return c;
+}
+
+
+// insert
+// ~~~~~~
+template<int D>
+inline void cell_list<D>::insert(const int i, const vector<D, int>& cell)
+{
+  int c = flat(cell);
+
+  nexts[i] = heads[c];
+  prevs[i] = -1;
+  if(heads[c] != -1)
+    prevs[heads[c]] = i;
+  heads[c] = i;
+  cellof[i] = c;
+}
+
+
+// remove
+// ~~~~~~
+template<int D>
+inline void cell_list<D>::remove(const int i)
+{
+  if(prevs[i] != -1)
+    nexts[prevs[i]] = nexts[i];
+  else
+    heads[cellof[i]] = nexts[i];
+  if(nexts[i] != -1)
+    prevs[nexts[i]] = prevs[i];
+  cellof[i] = -1;
+}
+
+
+// move
+// ~~~~
+template<int D>
+inline void cell_list<D>::move(const int i, const vector<D, int>& cell)
+{
+  remove(i);
+  insert(i, cell);
+}
+
+
+// contains
+// ~~~~~~~~
+template<int D>
+inline bool cell_list<D>::contains(const int i, const vector<D, int>& cell) const
+{
+  return (cellof[i] == flat(cell));
+}
+
+
+// head
+// ~~~~
+template<int D>
+inline int cell_list<D>::head(const int c) const
+{
+  return heads[c];
+}
+
+
+// next
+// ~~~~
+template<int D>
+inline int cell_list<D>::next(const int i) const
+{
+  return nexts[i];
+}
+
+
+#endif
@@ -0,0 +1,52 @@
+//---------------------------------------------------------------------------
+// Binary checkpoint of a box
+//---------------------------------------------------------------------------
+
+#ifndef  CHECKPOINT_H
+#define  CHECKPOINT_H
+
+#include <stdint.h>
+
+#define CHECKPOINTMAGIC   "SPHCKPT"     // 7 characters and the terminating 0
+#define CHECKPOINTVERSION 1             // raise with every change of the layout
+#define BYTEORDER         0x01020304u   // reads back the same only on the same byte order
+
+//---------------------------------------------------------------------------
+// Class checkpointheader: start of a checkpoint file. All fields have
+// fixed sizes and every double sits on 8 bytes, so the header comes out
+// of a mapped file with one memcpy. After it, N entries each of
+// x, v, lutime, cell and nextevent; cslot and tslot if lazy; the spheres
+// in the order of the cell lists; with a skin X, rb, the size of each
+// neighbour list and the nentries entries; last the kind of event queue,
+// in 16 characters, and its bytes after their count as uint64_t.
+//---------------------------------------------------------------------------
+class checkpointheader
+{
+public:
+    char magic[8];                  // CHECKPOINTMAGIC
+    uint32_t version;               // CHECKPOINTVERSION
+    uint32_t byteorder;             // BYTEORDER
+    int32_t dim;
+    int32_t N;
+    int32_t eventbytes;             // sizeof(event), the bit fields are up to the compiler
+    int32_t lazy;
+    int32_t ngrids;
+    int32_t ncycles;
+    int32_t neventstot;
+    int32_t nentries;               // entries on all neighbour lists, 0 without a skin
+    uint64_t seed;
+    uint64_t counter;               // random numbers drawn so far
+    double skin;
+    double r;
+    double growthrate;
+    double gtime;
+    double rtime;
+    double outgrowtime;
+    double pressure;
+    double xmomentum;
+    double pf;
+    double energy;
+    double energychange;
+};
+
+#endif
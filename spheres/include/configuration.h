@@ -0,0 +1,100 @@
+#ifndef CONFIGURATION_H
+#define CONFIGURATION_H
+
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+
+// ======================================================================
+// configheader
+// ======================================================================
+
+// A configuration in binary, as written by spheres and spheres_poly and
+// read by the discretizer in utility: this header, then the dim
+// coordinates of each of the N spheres one sphere after the other, then
+// with CONFIG_RADII the radius of each sphere. Every field has a fixed
+// size and the header takes 64 bytes, so in a mapped file the arrays
+// start on 8 bytes and are used where they lie, without parsing.
+
+#define CONFIGMAGIC       "SPHCONF"     // 7 characters and the terminating 0
+#define CONFIGVERSION     1             // raise with every change of the layout
+#define CONFIGBYTEORDER   0x01020304u   // reads back the same only on the same byte order
+
+#define CONFIG_RADII      1             // flag: N radii follow the coordinates
+#define CONFIG_HARDWALLS  2             // flag: hard walls instead of periodic boundaries
+
+class configheader {
+
+ public:
+  char magic[8];                // CONFIGMAGIC
+  uint32_t version;             // CONFIGVERSION
+  uint32_t byteorder;           // CONFIGBYTEORDER
+  int32_t dim;
+  int32_t N;
+  int32_t flags;                // CONFIG_RADII, CONFIG_HARDWALLS
+  int32_t reserved;             // 0
+  uint64_t seed;                // of the run that made it
+  double radius;                // of every sphere, the largest one with CONFIG_RADII
+  double size;                  // side of the box
+  double pf;                    // packing fraction
+
+  configheader();               // magic, version and byte order of this build, the rest 0
+
+  bool valid() const;           // magic, version and byte order of this build
+  size_t bytes() const;         // of the whole file
+  const double* x(const char* data) const;        // coordinates, data is the whole file
+  const double* radii(const char* data) const;    // 0 without CONFIG_RADII
+};
+
+static_assert(sizeof(configheader) == 64, "configheader must keep the arrays on 8 bytes");
+
+
+// configheader
+// ~~~~~~~~~~~~
+inline configheader::configheader()
+  : version(CONFIGVERSION), byteorder(CONFIGBYTEORDER), dim(0), N(0), flags(0), reserved(0),
+    seed(0), radius(0.), size(0.), pf(0.)
+{
+  strncpy(magic, CONFIGMAGIC, sizeof(magic));
+}
+
+
+// valid
+// ~~~~~
+inline bool configheader::valid() const
+{
+  return (strncmp(magic, CONFIGMAGIC, sizeof(magic)) == 0) && (version == CONFIGVERSION)
+    && (byteorder == CONFIGBYTEORDER) && (dim > 0) && (N >= 0);
+}
+
+
+// bytes
+// ~~~~~
+inline size_t configheader::bytes() const
+{
+  size_t n = sizeof(configheader) + (size_t)N*dim*sizeof(double);
+  if(flags & CONFIG_RADII)
+    n += (size_t)N*sizeof(double);
+  return n;
+}
+
+
+// x
+// ~
+inline const double* configheader::x(const char* data) const
+{
+  return (const double*)(data + sizeof(configheader));
+}
+
+
+// radii
+// ~~~~~
+inline const double* configheader::radii(const char* data) const
+{
+  if(!(flags & CONFIG_RADII))
+    return 0;
+  return x(data) + (size_t)N*dim;
+}
+
+
+#endif
@@ -0,0 +1,101 @@
+//---------------------------------------------------------------------------
+// Ensemble of independent packings run on a work-stealing thread pool
+//---------------------------------------------------------------------------
+
+#ifndef  ENSEMBLE_H
+#define  ENSEMBLE_H
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdint.h>
+
+#include "read_input.h"
+
+
+//---------------------------------------------------------------------------
+// Class run: parameters of one packing in the ensemble
+//---------------------------------------------------------------------------
+class run
+{
+public:
+    int N;                          // number of spheres
+    double maxpf;                   // max packing fraction, the last of targets
+    std::vector<double> targets;    // packing fractions to write a configuration at, ascending
+    double growthrate;              // growth rate
+    uint64_t seed;                  // seed of the random number generator
+    char writefile[NAME_LEN];       // file to write configuration, with %d for the target if several
+    char datafile[NAME_LEN];        // file to write statistics
+};
+
+int read_runs(const char* filename, std::vector<run>& runs);
+/**
+ * reads one run per line after a header line:
+ * N maxpf growthrate seed writefile datafile
+ * seed 0 lets the box draw its own seed.
+ * maxpf may list several packing fractions separated by commas, then
+ * writefile holds a %d that numbers the configurations from 0 up.
+ * return:
+ * 0 on success, nonzero if the file can't be opened or has no runs.
+ */
+int set_targets(run& r, const char* pfs);
+/**
+ * targets and maxpf of r from a comma-separated list of packing fractions,
+ * sorted; several need a %d in r.writefile;
+ * return:
+ * 0 on success, nonzero if the list can't be read.
+ */
+
+
+//---------------------------------------------------------------------------
+// Class threadpool
+//---------------------------------------------------------------------------
+class threadpool
+{
+public:
+    // constructor and destructor
+    threadpool(int nthreads_i);
+    /**
+     * starts nthreads_i workers, or one per hardware thread if nthreads_i <= 0;
+     */
+    ~threadpool();
+
+    void submit(std::function<void()> task);
+    /**
+     * pushes task onto the queue of the next worker (round robin);
+     */
+    void wait();
+    /**
+     * blocks until every submitted task has finished;
+     */
+
+    int nthreads;                   // number of worker threads
+
+private:
+    void worker(int id);
+    /**
+     * pops tasks from the back of its own queue;
+     * when that is empty, steals from the front of the other queues;
+     * sleeps when there is nothing left to steal.
+     */
+    bool pop(int id, std::function<void()>& task);
+    bool steal(int id, std::function<void()>& task);
+
+    std::vector< std::deque< std::function<void()> > > queues;  // one queue per worker
+    std::vector<std::mutex> locks;  // one lock per queue
+    std::vector<std::thread> threads;
+
+    std::mutex waitlock;            // guards stop and unfinished
+    std::condition_variable wake;   // signals queued work or stop
+    std::condition_variable idle;   // signals unfinished == 0
+    std::atomic<int> queued;        // tasks waiting in the queues
+    int unfinished;                 // tasks submitted but not yet finished
+    int next;                       // queue that gets the next task
+    bool stop;
+};
+
+#endif
@@ -5,53 +5,44 @@
 #define INF    100000000
 #define dblINF 100000000.
 
+#define EVENTBITS ((62 - 2*DIM)/2)   // bits of i and j, so N < 2^EVENTBITS
+
+enum eventkind { COLLISION = 0, TRANSFER = 1, CHECK = 2, EXPIRY = 3 };
+
+//---------------------------------------------------------------------------
+// Class event: 16 bytes and trivially copyable, so events can be copied
+// with memcpy and kept in arrays. The kind is an explicit tag, and the
+// image of the collision partner takes 2 bits per dimension.
+//---------------------------------------------------------------------------
 class event
 {
 public:
-    // constructor and destructor
+    // constructors
     event(double time_i, int i_i, int j_i, vector<DIM,int> v_i);
-    event(double time_i, int i_i, int j_i);
-    event(const event& e);
+    /**
+     * collision of i with the image v of j, every v[k] in {-1, 0, 1};
+     */
+    event(double time_i, int i_i, eventkind kind_i, int wall_i = 0);
+    /**
+     * check, expiry of the neighbour list of i, or transfer of i through
+     * wall wall_i = -(k+1) for the left and (k+1) for the right wall
+     * perpendicular to k;
+     */
     event();
-    ~event();
 
     bool operator<(const event&) const;
     bool operator>(const event&) const;
     void erase();
 
+    vector<DIM,int> image() const;   // image of j if collision
+    int wall() const;                // wall index if transfer
+
     //variables
-    double time;             // time of next collision
-    int i;        // collision partner with lower number
-    int j;        // collision partner with higher number
-    vector<DIM, int> v;        // virtual image
-
-    /*
-    if 0 <= j < N, collision between i and j;
-
-    if j == N + DIM + 1 + x, transfer of i;
-    where wall index x = -(k + 1) for left wall and x = (k + 1) for right wall.
-    For example, if DIM = 3, then k = 0, 1, 2, and wall index will be -1, 1, -2, 2, -3, 3;
-
-    if j == INF, check for i;
-
-    if j == -1, it means check after collision
-
-    Virtual identifiers as scalars...I think bad idea, but here's my work
-    there will be easily fixed problems if DIM>=10
-    -x<=v<=x               x=k+1, image in k direction
-    v=xy                   x,y
-    =-xy                  -x,y
-    =-yx                  x,-y
-    =yx                   -x,-y
-    v=xyz                  x,y,z
-    =-xyz                 -x,y,z
-    =-yxz                 x,-y,z
-    =-zxy                 x,y,-z
-    =zyx                  -x,-y,z
-    =xzy                  x,-y,-z
-    =yzx                  -x,y,-z
-    =-zyx                 -x,-y,-z
-    */
+    double time;                              // time of the event
+    unsigned long long i : EVENTBITS;         // sphere of the event
+    unsigned long long j : EVENTBITS;         // partner if collision, wall + DIM if transfer
+    unsigned long long kind : 2;              // eventkind
+    unsigned long long offset : 2*DIM;        // image of j, v[k] + 1 in bits 2k, 2k+1
 };
 
 #endif 
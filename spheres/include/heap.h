@@ -7,6 +7,22 @@
 
 #include "event.h"
 #include "sphere.h"
+#include "sphere_store.h"
+#include <ostream>
+
+#define HEAPARITY 4    // children per node, HEAPARITY nodes fill one cache line
+#define CACHELINE 64   // bytes
+
+//---------------------------------------------------------------------------
+// Heap entry: the event time is kept next to the sphere index, so the
+// comparisons in upheap and downheap never touch the sphere array
+//---------------------------------------------------------------------------
+class heapnode
+{
+public:
+    double time;                    // time of the sphere's next event
+    int i;                          // sphere
+};
 
 class heap
 {
@@ -19,19 +35,44 @@ public:
     // variables
     int maxsize;   // max allowed number of events
     int N;         // current number of events
-    int *a;
-    sphere *s;
+    heapnode *a;   // entries 1..N, the children of k are D(k-1)+2 .. Dk+1
+    heapnode *block;  // allocation holding a, padded so each family of children shares a cache line
+    sphere_store *s;
     int *index;     // array of indices for each sphere
     //event minevent;
 
-    // functions which operate on a binary heap
+    // functions which operate on a d-ary heap
     void upheap(int k);
     void downheap(int k);
+    /**
+     * both read the new time of the moved sphere from s once and
+     * store it in its entry;
+     */
+    void update(int i);
+    /**
+     * restores the heap after s[i].nextevent.time changed either way;
+     */
     void insert(int i);
     void replace(int i);
     int search(int j);
     void change(int i); 
     int extractmax();
+    void refresh();
+    /**
+     * reloads every time from s and rebuilds the heap, needed after
+     * event times are changed without an upheap or downheap (Synchronize);
+     */
+    static const char* kind();
+    void write(std::ostream& out) const;
+    /**
+     * the spheres in the order of a, for box::WriteCheckpoint;
+     */
+    bool read(const char* data, size_t size);
+    /**
+     * queues the spheres of write in their order, with their times from s;
+     * return:
+     * false if size bytes do not hold a queue of at most maxsize spheres;
+     */
     void print();
     void checkindex();
 };
@@ -0,0 +1,61 @@
+//---------------------------------------------------------------------------
+// Reader of LAMMPS data files
+//---------------------------------------------------------------------------
+
+#ifndef  LAMMPS_DATA_H
+#define  LAMMPS_DATA_H
+
+#include <cstddef>
+#include <vector>
+
+#define LAMMPSCHUNK (1 << 20)   // bytes of atom lines per thread, at least
+
+//---------------------------------------------------------------------------
+// Class lammps_data: the atoms of a LAMMPS data file that is already in
+// memory, such as a mapped_file, as WriteLAMMPS and older versions of
+// WriteConfiguration wrote them. The header is read up to the Atoms line,
+// wherever that is, and the atom lines "id type x1 .. xdim" are parsed in
+// place, without a stream or locale: integers by hand, and decimals by hand
+// when the digits and the power of ten are both exact doubles, which is
+// then one correctly rounded multiplication or division, otherwise by strtod.
+// The atom lines are split into chunks of whole lines parsed on threads of
+// their own; the id of a line says where it goes.
+//---------------------------------------------------------------------------
+class lammps_data
+{
+public:
+    // constructor
+    lammps_data(const char* data_i, size_t size_i);
+    /**
+     * reads the header of the size_i bytes at data_i, which must stay;
+     */
+
+    bool read(int dim, double* x, int* types, int nthreads) const;
+    /**
+     * the dim coordinates of atom id to x + (id-1)*dim, and its type to
+     * types[id-1] unless types is 0; on up to nthreads threads;
+     * return:
+     * false unless there are natoms lines with all fields and ids in 1 .. natoms;
+     */
+    static bool parse(const char*& p, const char* end, int& value);
+    static bool parse(const char*& p, const char* end, double& value);
+    /**
+     * the number at p after blanks, p then points past it;
+     * return:
+     * false if there is none;
+     */
+
+    // variables
+    int natoms;                     // of the "N atoms" line, -1 without one
+    std::vector<double> masses;     // of types 1, 2, .. in the Masses section
+    const char* atoms;              // first atom line, 0 without an Atoms section
+    const char* end;                // end of the atom lines
+
+private:
+    bool chunk(const char* p, const char* e, int dim, double* x, int* types, int& lines) const;
+    /**
+     * parses the whole lines in [p, e) and counts them in lines;
+     */
+};
+
+#endif
@@ -0,0 +1,53 @@
+//---------------------------------------------------------------------------
+// Read-only view of a whole file
+//---------------------------------------------------------------------------
+
+#ifndef  MAPPED_FILE_H
+#define  MAPPED_FILE_H
+
+#include <cstddef>
+
+//---------------------------------------------------------------------------
+// Class mapped_file: the bytes of a file, mapped into memory with mmap
+// where there is one, so pages are only read from disk when touched and
+// nothing is copied through a stream buffer; elsewhere the file is read
+// into memory in one go.
+//---------------------------------------------------------------------------
+class mapped_file
+{
+public:
+    // constructor and destructor
+    mapped_file();
+    ~mapped_file();
+
+    bool open(const char* filename);
+    /**
+     * maps the whole of filename, closing what was open before;
+     * return:
+     * false if the file cannot be opened or is empty;
+     */
+    void close();
+
+    const char* data() const;
+    size_t size() const;
+
+private:
+    mapped_file(const mapped_file&);
+
+    const char* bytes;              // first byte of the file, 0 if none is open
+    size_t length;                  // bytes in the file
+    bool mapped;                    // bytes come from mmap, otherwise from new[]
+};
+
+
+inline const char* mapped_file::data() const
+{
+    return bytes;
+}
+
+inline size_t mapped_file::size() const
+{
+    return length;
+}
+
+#endif
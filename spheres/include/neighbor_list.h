@@ -0,0 +1,74 @@
+//---------------------------------------------------------------------------
+// Neighbour lists with a skin
+//---------------------------------------------------------------------------
+
+#ifndef  NEIGHBOR_LIST_H
+#define  NEIGHBOR_LIST_H
+
+#include <vector>
+#include "vector.h"
+
+//---------------------------------------------------------------------------
+// Class neighbor_list: every sphere i stays inside a bounding sphere of
+// radius rb[i] around X[i], and the list of i holds each sphere j whose
+// bounding sphere overlaps that of i, with the image of j. Spheres that
+// are not on each other's lists cannot collide before one of them leaves
+// its bounding sphere. The lists are symmetric: j is on the list of i at
+// pboffset exactly when i is on the list of j at -pboffset.
+//---------------------------------------------------------------------------
+class neighbor_list
+{
+public:
+    class entry
+    {
+    public:
+        int j;
+        vector<DIM, int> pboffset;      // image of j seen from i
+    };
+
+    // constructor and destructor
+    neighbor_list();
+    ~neighbor_list();
+
+    void allocate(int N);
+    /**
+     * N empty lists;
+     */
+    void add(int i, int j, const vector<DIM, int>& pboffset);
+    /**
+     * j at image pboffset onto the list of i, and i at -pboffset onto the list of j;
+     */
+    void remove(int i);
+    /**
+     * takes i off the lists of all its neighbours and empties the list of i;
+     */
+    void assign(int i, const entry* first, int n);
+    /**
+     * the n entries at first become the list of i, the lists of its
+     * neighbours stay as they are, for box::ReadCheckpoint;
+     */
+    int size(int i) const;
+    const entry* list(int i) const;
+
+    // variables
+    vector<DIM> *X;                 // centre of the bounding sphere of each sphere
+    double *rb;                     // radius of the bounding sphere of each sphere
+
+private:
+    neighbor_list(const neighbor_list&);
+
+    std::vector<entry> *lists;
+};
+
+
+inline int neighbor_list::size(int i) const
+{
+    return (int)lists[i].size();
+}
+
+inline const neighbor_list::entry* neighbor_list::list(int i) const
+{
+    return lists[i].data();
+}
+
+#endif
@@ -0,0 +1,86 @@
+//---------------------------------------------------------------------------
+// Batched collision prediction
+//---------------------------------------------------------------------------
+
+#ifndef  PREDICTOR_H
+#define  PREDICTOR_H
+
+#include "vector.h"
+
+#if defined(__AVX512F__)
+#define PREDICTORWIDTH 8      // candidates per SIMD step
+#elif defined(__AVX2__)
+#define PREDICTORWIDTH 4
+#else
+#define PREDICTORWIDTH 1      // scalar fallback
+#endif
+
+//---------------------------------------------------------------------------
+// Class predictor: the collision candidates of one sphere i, gathered from
+// its neighbour cells into contiguous arrays, one per coordinate, so that
+// the collision times of PREDICTORWIDTH candidates are computed at once.
+// Every candidate goes through the same operations in the same order as
+// box::CalculateCollision and box::QuadraticFormula, so the predicted
+// times do not depend on the width.
+//---------------------------------------------------------------------------
+class predictor
+{
+public:
+    // constructor and destructor
+    predictor();
+    ~predictor();
+
+    void clear();
+    void add(int j, const vector<DIM, int>& pboffset, const vector<DIM>& x_j,
+             const vector<DIM>& v_j, double lutime_j, double time_j);
+    /**
+     * appends j at the image pboffset: x_j is the position of that image
+     * and v_j the velocity at lutime_j, time_j the time of j's next event;
+     */
+    int earliest(const vector<DIM>& x_i, const vector<DIM>& v_i, double gtime,
+                 double r_now, double growthrate, double& ctime_i);
+    /**
+     * x_i and v_i at gtime; returns the first candidate whose collision
+     * with i, at ctime_i, comes before both the collisions with the other
+     * candidates and its own next event, or -1 with ctime_i = dblINF;
+     * suspect is set if a candidate overlaps i or has a negative time,
+     * and box::FindNextCollision then reports it;
+     */
+
+    // variables
+    int n;                          // number of candidates
+    int capacity;
+    bool suspect;
+    int *j;                         // sphere of each candidate
+    vector<DIM, int> *pboffset;     // image of each candidate
+    double *x[DIM];                 // image position, coordinate k in x[k]
+    double *v[DIM];
+    double *lutime;
+    double *time;                   // next event of each candidate
+    double *ctime;                  // predicted collision time of each candidate
+
+private:
+    predictor(const predictor&);
+    void grow();
+};
+
+
+inline void predictor::add(int j_i, const vector<DIM, int>& pboffset_i, const vector<DIM>& x_j,
+                           const vector<DIM>& v_j, double lutime_j, double time_j)
+{
+    if (n == capacity)
+        grow();
+
+    j[n] = j_i;
+    pboffset[n] = pboffset_i;
+    for (int k=0; k<DIM; k++)
+    {
+        x[k][n] = x_j.x[k];
+        v[k][n] = v_j.x[k];
+    }
+    lutime[n] = lutime_j;
+    time[n] = time_j;
+    n++;
+}
+
+#endif
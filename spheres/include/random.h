@@ -0,0 +1,103 @@
+//---------------------------------------------------------------------------
+// Counter-based random number generator
+//---------------------------------------------------------------------------
+
+#ifndef  RANDOM_H
+#define  RANDOM_H
+
+#include <stdint.h>
+#include <math.h>
+
+// Every box owns one of these, so boxes can run on separate threads and a run
+// is replayed exactly from its seed. The k-th number depends only on (seed, k):
+// it is the SplitMix64 finalizer applied to seed + k*golden ratio.
+
+class rng
+{
+public:
+    // constructor
+    rng(uint64_t seed_i = 0): seed(seed_i), counter(0) { }
+
+    uint64_t at(uint64_t k) const;
+    /**
+     * k-th 64-bit number of the stream, without touching counter;
+     */
+    uint64_t next();
+    /**
+     * at(counter++);
+     */
+    double uniform();
+    /**
+     * uniform double in [0, 1) with 53 random bits;
+     */
+    double uniform(double a, double b);
+    /**
+     * uniform double in [a, b);
+     */
+    void normal(double* g, int n);
+    /**
+     * fills g[0..n) with standard normal deviates by the Box-Muller transform;
+     * uniforms are drawn first, then transformed pairwise in a loop without
+     * branches or dependencies, which the compiler can vectorize.
+     */
+
+    //variables
+    uint64_t seed;                  // key of the stream
+    uint64_t counter;               // numbers drawn so far
+};
+
+
+// at
+// ~~
+inline uint64_t rng::at(uint64_t k) const
+{
+    uint64_t z = seed + (k + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+// next
+// ~~~~
+inline uint64_t rng::next()
+{
+    return at(counter++);
+}
+
+
+// uniform
+// ~~~~~~~
+inline double rng::uniform()
+{
+    return (double)(next() >> 11) * (1.0/9007199254740992.0);
+}
+
+inline double rng::uniform(double a, double b)
+{
+    return a + uniform() * (b - a);
+}
+
+
+// normal
+// ~~~~~~
+inline void rng::normal(double* g, int n)
+{
+    int m = n & ~1;   // even part, transformed pairwise
+
+    for (int k = 0; k < n; k++)
+        g[k] = uniform();
+
+    for (int k = 0; k < m; k += 2)
+    {
+        double radius = sqrt(-2.*log(1. - g[k]));   // 1 - u is in (0, 1]
+        double phi = 6.283185307179586*g[k+1];
+        g[k] = radius*cos(phi);
+        g[k+1] = radius*sin(phi);
+    }
+
+    if (m < n)        // odd n, one more pair for the last deviate
+        g[m] = sqrt(-2.*log(1. - g[m]))*cos(6.283185307179586*uniform());
+}
+
+#endif
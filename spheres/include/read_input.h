@@ -1,6 +1,8 @@
 #ifndef READ_INPUT_H
 #define READ_INPUT_H
 
+#include <stdint.h>
+
 #define NAME_LEN 256
 
 
@@ -15,11 +17,22 @@ public:
   double temp;                      // initial temperature (temp=0 means v=0)
   double growthrate;               
   double maxpressure;              
-  char readfile[NAME_LEN];    // file with configuration; if new, creates new
+  char readfile[NAME_LEN];    // new, lattice, or a configuration to go on from
   char writefile[NAME_LEN];    // file to write configuration
   char datafile[NAME_LEN];       // file to write statistics
+  uint64_t seed;                  // seed of the random number generator, 0 draws one (optional)
+  double cellwidth;               // cell width in diameters, 0 for the fixed grid of maxpf (optional)
+  double skin;                    // neighbour-list skin in diameters, 0 for cell transfers (optional)
+  int lazy;                       // 1 keeps a collision and a transfer event per sphere (optional)
+  int threads;                    // threads of each packing for the bulk event prediction (optional)
+  double growthcontrol;           // fraction of the gap to jamming grown per cycle, 0 keeps growthrate (optional)
+  int checkpoint;                 // cycles between checkpoints of each packing, 0 writes none (optional)
+  int lammps;                     // 1 also exports each configuration as LAMMPS text (optional)
+  int trajectory;                 // cycles between frames of the trajectory of each packing, 0 writes none (optional)
+  char runfile[NAME_LEN];        // list of runs for the ensemble mode, empty if none
 
   int read(int argc, char* argv[]);
+  int option(const char* name, const char* value);
  
 };
 
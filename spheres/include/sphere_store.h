@@ -0,0 +1,79 @@
+//---------------------------------------------------------------------------
+// Storage of the state of all spheres
+//---------------------------------------------------------------------------
+
+#ifndef  SPHERE_STORE_H
+#define  SPHERE_STORE_H
+
+#include "event.h"
+#include "sphere.h"
+#include <cstddef>
+
+#define STOREALIGN 64   // bytes, every array of the SoA layout starts a cache line
+
+//---------------------------------------------------------------------------
+// Class sphere_store: the spheres of a box, read and written only through
+// the accessors below. By default each sphere is one sphere object (array
+// of structures); make LAYOUT=soa builds it as one aligned array per field
+// instead, so a loop over one field of all spheres streams that field only.
+//---------------------------------------------------------------------------
+class sphere_store
+{
+public:
+    // constructor and destructor
+    sphere_store();
+    ~sphere_store();
+
+    void allocate(int N);
+    /**
+     * room for N spheres, all fields default constructed;
+     */
+
+    // accessors of sphere i
+    event& nextevent(int i);
+    double& lutime(int i);
+    vector<DIM, int>& cell(int i);
+    vector<DIM>& x(int i);
+    vector<DIM>& v(int i);
+
+    void set(int i, const sphere& si);
+    /**
+     * copies every field of si into sphere i;
+     */
+    static const char* layout();
+    static size_t bytes();
+    /**
+     * memory per sphere, padding included;
+     */
+
+private:
+    sphere_store(const sphere_store&);
+
+#ifdef SOA_SPHERES
+    char *block;                    // one allocation holding all arrays
+    event *nextevents;
+    double *lutimes;
+    vector<DIM, int> *cells;
+    vector<DIM> *xs;
+    vector<DIM> *vs;
+#else
+    sphere *s;
+#endif
+};
+
+
+#ifdef SOA_SPHERES
+inline event& sphere_store::nextevent(int i) { return nextevents[i]; }
+inline double& sphere_store::lutime(int i) { return lutimes[i]; }
+inline vector<DIM, int>& sphere_store::cell(int i) { return cells[i]; }
+inline vector<DIM>& sphere_store::x(int i) { return xs[i]; }
+inline vector<DIM>& sphere_store::v(int i) { return vs[i]; }
+#else
+inline event& sphere_store::nextevent(int i) { return s[i].nextevent; }
+inline double& sphere_store::lutime(int i) { return s[i].lutime; }
+inline vector<DIM, int>& sphere_store::cell(int i) { return s[i].cell; }
+inline vector<DIM>& sphere_store::x(int i) { return s[i].x; }
+inline vector<DIM>& sphere_store::v(int i) { return s[i].v; }
+#endif
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef STENCIL_H
+#define STENCIL_H
+
+#include "vector.h"
+
+// ======================================================================
+// stencil
+// ======================================================================
+
+// The 3^D cells around a cell of a periodic grid of ngrids^D cells, as a
+// loop nest unrolled at compile time. x[0] runs fastest, so the cells come
+// in the order of the odometer loop this replaces:
+// (-1, -1) (0, -1) (1, -1) (-1, 0) (0, 0) (1, 0) (-1, 1) (0, 1) (1, 1)
+// A neighbour beyond the grid is wrapped around, and pboffset records the
+// image: -1 across the left boundary, 1 across the right one, 0 inside.
+// f(c, pboffset) gets the flat index c, x[0] fastest as in cell_list,
+// and returns true to stop the traversal.
+
+template<int D, class F>
+bool for_all_neighbor_cells(const vector<D, int>& cell, const int ngrids, F& f);
+
+
+// stencil_step
+// ~~~~~~~~~~~~
+// dimension K of the loop nest, c is the flat index of dimensions above K
+template<int D, int K>
+class stencil_step {
+
+ public:
+  template<class F>
+  static bool visit(const vector<D, int>& cell, const int ngrids, const int c,
+                    vector<D, int>& pboffset, F& f)
+  {
+    return shift<-1>(cell, ngrids, c, pboffset, f)
+        || shift<0>(cell, ngrids, c, pboffset, f)
+        || shift<1>(cell, ngrids, c, pboffset, f);
+  }
+
+ private:
+  template<int d, class F>
+  static bool shift(const vector<D, int>& cell, const int ngrids, const int c,
+                    vector<D, int>& pboffset, F& f)
+  {
+    int ck = cell.x[K] + d;
+    pboffset.x[K] = 0;
+    if(ck < 0) {
+      ck += ngrids;
+      pboffset.x[K] = -1;
+    }
+    else if(ck >= ngrids) {
+      ck -= ngrids;
+      pboffset.x[K] = 1;
+    }
+    return stencil_step<D, K-1>::visit(cell, ngrids, c*ngrids + ck, pboffset, f);
+  }
+};
+
+template<int D>
+class stencil_step<D, -1> {
+
+ public:
+  template<class F>
+  static bool visit(const vector<D, int>&, const int, const int c,
+                    vector<D, int>& pboffset, F& f)
+  {
+    return f(c, pboffset);
+  }
+};
+
+
+// for_all_neighbor_cells
+// ~~~~~~~~~~~~~~~~~~~~~~
+template<int D, class F>
+inline bool for_all_neighbor_cells(const vector<D, int>& cell, const int ngrids, F& f)
+{
+  vector<D, int> pboffset;
+  return stencil_step<D, D-1>::visit(cell, ngrids, 0, pboffset, f);
+}
+
+
+// ======================================================================
+// stencil_table
+// ======================================================================
+
+// The same stencil as ready-made (linear offset, image) slots, for a grid
+// whose ngrids is fixed between calls to set_size. Along each dimension
+// a cell is interior, on the left edge, on the right edge, or both when
+// ngrids == 1, and the slots only depend on these boundary classes. So
+// 4^D tables of 3^D slots cover every cell, and the neighbours of a cell
+// with flat index c are c + slot.delta, in the order of the odometer loop.
+// sides(m) tells which layers of the stencil slot m lies in, so that a
+// scan can leave out whole layers and still go through the same loop.
+
+constexpr int stencil_size(const int d)
+{
+  return (d == 0) ? 1 : 3*stencil_size(d-1);
+}
+
+template<int D>
+class stencil_table {
+
+ public:
+  static const int nslots = stencil_size(D);
+
+  class slot {
+   public:
+    int delta;                  // flat index of the neighbour minus that of the cell
+    vector<D, int> pboffset;    // image of the neighbour
+  };
+
+ private:
+  int ngrids;
+  slot* table;                  // nslots slots for each of the 4^D classes
+  int side[nslots];             // bit 2k: offset -1 along k, bit 2k+1: offset 1
+
+ public:
+
+  stencil_table();
+  ~stencil_table();
+
+  void set_size(const int ngrids_i);
+  const slot* slots(const vector<D, int>&) const;   // nslots slots of the cell's class
+  int sides(const int m) const;
+};
+
+// stencil_table
+// ~~~~~~~~~~~~~
+template<int D>
+stencil_table<D>::stencil_table()
+  : ngrids(0), table(0)
+{
+  for(int m=0; m<nslots; m++) {
+    side[m] = 0;
+    for(int k=0, digits=m; k<D; k++, digits /= 3) {
+      if(digits % 3 == 0)
+        side[m] |= 1 << (2*k);
+      else if(digits % 3 == 2)
+        side[m] |= 2 << (2*k);
+    }
+  }
+}
+
+
+// ~stencil_table
+// ~~~~~~~~~~~~~~
+template<int D>
+stencil_table<D>::~stencil_table()
+{
+  delete[] table;
+}
+
+
+// set_size
+// ~~~~~~~~
+template<int D>
+void stencil_table<D>::set_size(const int ngrids_i)
+{
+  delete[] table;
+  ngrids = ngrids_i;
+
+  int nclasses = 1;
+  for(int k=0; k<D; k++)
+    nclasses *= 4;
+  table = new slot[nclasses*nslots];
+
+  for(int cls=0; cls<nclasses; cls++) {
+    // a representative cell of the class: bit 0 left edge, bit 1 right edge
+    vector<D, int> cell;
+    int bits = cls;
+    for(int k=0; k<D; k++, bits /= 4) {
+      if((bits & 3) == 0 && ngrids < 3)
+        continue;               // no interior cells, no cell of this class
+      cell.x[k] = (bits & 1) ? 0 : ((bits & 2) ? ngrids - 1 : 1);
+    }
+
+    int c = 0;
+    for(int k=D-1; k>=0; k--)
+      c = c*ngrids + cell.x[k];
+
+    slot* s = table + cls*nslots;
+    int m = 0;
+    auto fill = [&](int neighbor, const vector<D, int>& pboffset) {
+      s[m].delta = neighbor - c;
+      s[m].pboffset = pboffset;
+      m++;
+      return false;
+    };
+    for_all_neighbor_cells(cell, ngrids, fill);
+  }
+}
+
+
+// slots
+// ~~~~~
+template<int D>
+inline const typename stencil_table<D>::slot* stencil_table<D>::slots(const vector<D, int>& cell) const
+{
+  int cls = 0;
+  for(int k=D-1; k>=0; k--)
+    cls = 4*cls + (cell.x[k] == 0) + 2*(cell.x[k] == ngrids - 1);
+
+  return table + cls*nslots;
+}
+
+
+// sides
+// ~~~~~
+template<int D>
+inline int stencil_table<D>::sides(const int m) const
+{
+  return side[m];
+}
+
+
+#endif
@@ -0,0 +1,149 @@
+//---------------------------------------------------------------------------
+// Compressed trajectories, written on a thread of their own
+//---------------------------------------------------------------------------
+
+#ifndef  TRAJECTORY_H
+#define  TRAJECTORY_H
+
+#include <stdint.h>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "vector.h"
+#include "mapped_file.h"
+
+#define TRAJMAGIC      "SPHTRAJ"    // 7 characters and the terminating 0
+#define TRAJVERSION    1            // raise with every change of the layout
+#define TRAJBYTEORDER  0x01020304u  // reads back the same only on the same byte order
+#define TRAJBITS       20           // bits per coordinate, a quantum of SIZE/2^20
+#define TRAJKEYFRAME   100          // frames from one key frame to the next
+#define TRAJBUFFERS    3            // frames that push can hand over before it waits
+
+//---------------------------------------------------------------------------
+// A trajectory file is one trajheader and then frames, each a trajframe
+// and its bytes. Every coordinate is quantized to q = floor(x 2^bits/size)
+// mod 2^bits, periodic like the box. A key frame holds q itself, any
+// other frame the difference to q of the frame before it, taken around
+// the box into [-2^(bits-1), 2^(bits-1)); either goes zigzag encoded as a
+// LEB128 varint, sphere after sphere and dim numbers per sphere. A sphere
+// moves little from one frame to the next, so most take 1 or 2 bytes.
+// After a restart from a checkpoint frames are appended, starting with a
+// key frame.
+//---------------------------------------------------------------------------
+class trajheader
+{
+public:
+    char magic[8];                  // TRAJMAGIC
+    uint32_t version;               // TRAJVERSION
+    uint32_t byteorder;             // TRAJBYTEORDER
+    int32_t dim;
+    int32_t N;
+    int32_t bits;                   // TRAJBITS
+    int32_t reserved;               // 0
+    uint64_t seed;                  // of the run
+    double size;                    // side of the box
+};
+
+class trajframe
+{
+public:
+    uint32_t bytes;                 // that follow this
+    int32_t key;                    // 1 for a key frame
+    double time;                    // rtime + gtime
+    double r;                       // radius at time
+    double pf;                      // packing fraction at time
+};
+
+
+//---------------------------------------------------------------------------
+// Class trajectory: appends frames to a trajectory file. push copies the
+// positions into a free buffer and returns; a thread of the trajectory
+// encodes the buffers in order, writes them and frees them again.
+//---------------------------------------------------------------------------
+class trajectory
+{
+public:
+    // constructor and destructor
+    trajectory(const char* filename, int N_i, double size_i, uint64_t seed, bool append);
+    /**
+     * a new file for N_i spheres in a box of side size_i, or with append
+     * the end of filename if it holds frames of the same kind already;
+     */
+    ~trajectory();
+    /**
+     * writes the frames still queued and closes the file;
+     */
+
+    void push(const vector<DIM>* x, double time, double r, double pf);
+    /**
+     * one frame of the N positions x, in the box or not; waits only if
+     * all TRAJBUFFERS buffers are still queued;
+     */
+
+private:
+    trajectory(const trajectory&);
+
+    void write();
+    /**
+     * body of the thread: encodes and writes queued buffers until done;
+     */
+    void encode(const vector<DIM>* x, bool key);
+    /**
+     * the bytes of one frame of x into bytes, against last;
+     */
+
+    class buffer
+    {
+    public:
+        vector<DIM>* x;
+        trajframe frame;
+    };
+
+    const int N;
+    const double scale;             // quanta per unit length
+    std::ofstream out;
+    std::vector<buffer> buffers;
+    std::deque<int> queued;         // buffers to write, in order
+    std::deque<int> unused;         // buffers push may fill
+    bool done;                      // set by the destructor
+    std::mutex lock;                // guards queued, unused and done
+    std::condition_variable changed;
+    std::vector<int32_t> last;      // quantized coordinates of the frame written last
+    std::vector<unsigned char> bytes;
+    int nframes;                    // written by this trajectory
+    std::thread writer;             // started last, after all it uses
+};
+
+
+//---------------------------------------------------------------------------
+// Class trajectory_reader: the frames of a trajectory file one by one
+//---------------------------------------------------------------------------
+class trajectory_reader
+{
+public:
+    bool open(const char* filename);
+    /**
+     * maps filename and reads its header;
+     * return:
+     * false if it is not a trajectory of this version, dimension and byte order;
+     */
+    bool next(trajframe& frame, double* x);
+    /**
+     * the next frame and its N*dim coordinates in [0, size);
+     * return:
+     * false at the end of the file or on a damaged frame;
+     */
+
+    trajheader header;
+
+private:
+    mapped_file file;
+    const char* p;                  // next frame
+    std::vector<int32_t> last;
+};
+
+#endif
@@ -24,9 +24,13 @@
 
 #include "vector.h"
 #include "grid_field.h"
+#include "cell_list.h"
+#include "stencil.h"
 #include "event.h"
 #include "sphere.h"
 #include "heap.h"
+#include "calendar.h"
+#include "random.h"
 
 
 #define PI     3.141592653589793238462643
@@ -35,6 +39,12 @@
 #define DBL_EPSILON  2.2204460492503131e-016 // smallest # such that 1.0+DBL_EPSILON!=1.0
 #define M 1.0
 
+#ifdef CALENDAR_QUEUE         // make QUEUE=calendar
+typedef calendar eventqueue;
+#else
+typedef heap eventqueue;
+#endif
+
 //---------------------------------------------------------------------------
 // Class neighbor
 //---------------------------------------------------------------------------
@@ -46,7 +56,7 @@ class neighbor
   neighbor(int i_i);
 
  public:
-  virtual void Operation(int j, vector<DIM, int>& pboffset) = 0;
+  virtual void Operation(int j, const vector<DIM, int>& pboffset) = 0;
 };
 
 
@@ -57,7 +67,7 @@ class box {
   // constructor and destructor
   box(int N_i, double r_i, double growthrate_i, double maxpf_i, 
       double bidispersityratio, double bidispersityfraction, 
-      double massratio, int hardwallBC);
+      double massratio, int hardwallBC, uint64_t seed);
   ~box();
 
   // Creating configurations
@@ -66,7 +76,10 @@ class box {
   void CreateSpheres(double temp);
   void CreateSphere(int Ncurrent);   
   double Velocity(double temp);
-  void VelocityGiver(double temp);  
+  void VelocityGiver(double temp, bool zerodrift = true, bool exacttemp = true);
+  // draws all velocities at once from the Maxwell-Boltzmann distribution of
+  // each sphere's mass; zerodrift removes the centre-of-mass velocity,
+  // exacttemp rescales so that sum(m*v*v) equals temp per degree of freedom
   void SetInitialEvents();
   void RecreateSpheres(const char* filename, double temp);
   void ReadPositions(const char* filename);
@@ -77,7 +90,9 @@ class box {
   void CollisionChecker(event c);
   event FindNextTransfer(int i);
   event FindNextCollision(int i);
-  void ForAllNeighbors(int, vector<DIM, int>, vector<DIM,int>, neighbor&);
+  void ForAllNeighbors(int, neighbor&);   // the 3^DIM cells around i's
+  void ForAllNeighbors(vector<DIM, int>, vector<DIM, int>, vector<DIM,int>, 
+		       neighbor&);
   void PredictCollision(int i, int j, vector<DIM, int> pboffset, 
 			double& ctime, int& cpartner, 
 			vector<DIM, int>& cpartnerpboffset);
@@ -105,7 +120,8 @@ class box {
   double PackingFraction();  
   void PrintStatistics();
   void RunTime();
-  void WriteConfiguration(const char* wconfigfile);
+  void WriteConfiguration(const char* wconfigfile);   // binary, see configuration.h
+  void WriteLAMMPS(const char* lammpsfile);          // LAMMPS text, one type per species
   
   
   //variables
@@ -123,6 +139,8 @@ class box {
   double bidispersityfraction;   // fraction of larger spheres
   double massratio;              // ratio of sphere masses
   int hardwallBC;                // =0 for periodic BC, =1 for hard wall
+  uint64_t seed;                 // seed of the random number generator
+  rng random;                    // random number generator of this box
   
 
   // statistics
@@ -141,9 +159,9 @@ class box {
 
   // arrays
   sphere *s;                      // array of spheres
-  grid_field<DIM, int> cells; // array that keeps track of spheres in each cell
-  int *binlist;                   // linked-list for cells array
-  heap h;                         // event heap
+  cell_list<DIM> cells;           // spheres in each cell
+  stencil_table<DIM> stencil;     // neighbor cells of each cell, for ngrids
+  eventqueue h;                   // event heap, or calendar queue
   vector<DIM> *x;                 // positions of spheres.used for graphics
 };
 
@@ -163,7 +181,26 @@ class collision : public neighbor
  public:
   collision(int i_i, box *b);
 
-  virtual void Operation(int j, vector<DIM, int>& pboffset);
+  virtual void Operation(int j, const vector<DIM, int>& pboffset);
+};
+
+
+//---------------------------------------------------------------------------
+// Checks a trial position for overlaps, inherits neighbor operation
+//---------------------------------------------------------------------------
+class overlap : public neighbor 
+{
+ public:
+  
+  box *b; 
+  vector<DIM> x;                  // trial position of sphere i
+  double radius;                  // trial radius of sphere i
+  bool found;                     // true once an overlapping sphere is seen
+
+ public:
+  overlap(int i_i, box *b, vector<DIM> x_i, double radius_i);
+
+  virtual void Operation(int j, const vector<DIM, int>& pboffset);
 };
 
 #endif 
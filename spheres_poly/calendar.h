@@ -0,0 +1,72 @@
+//---------------------------------------------------------------------------
+// Calendar queue of events, alternative to the event heap
+//---------------------------------------------------------------------------
+
+#ifndef  CALENDAR_H
+#define  CALENDAR_H
+
+#include "event.h"
+#include "sphere.h"
+
+#define CALENDARCHECK 64      // updates between checks of the bucket width
+#define CALENDARMEMORY 1024   // updates over which the lookahead is averaged
+
+//---------------------------------------------------------------------------
+// Calendar entry of one sphere, everything link and unlink touch
+//---------------------------------------------------------------------------
+class calendarnode {
+
+ public:
+  double time;                    // event time, as queued
+  long long slot;                 // virtual bucket, floor(time/width)
+  int next;                       // later sphere in the same bucket
+  int prev;                       // earlier sphere in the same bucket, -1 at the head
+};
+
+//---------------------------------------------------------------------------
+// Class calendar: every sphere has one event, events are hashed by time
+// into nbuckets buckets of the given width (R. Brown, Comm. ACM 31, 1988).
+// A bucket is a time-sorted list linked through the spheres, so its head
+// is its earliest event. Spheres of all "years" share a bucket; the
+// virtual bucket slot = floor(time/width) tells them apart exactly.
+//---------------------------------------------------------------------------
+class calendar {
+
+ public:
+
+  // constructor and destructor
+  calendar(int maxsize);
+  ~calendar();
+
+  // variables
+  int maxsize;   // max allowed number of events
+  int N;         // current number of events
+  sphere *s;
+
+  int nbuckets;                   // power of 2, at least maxsize
+  double width;                   // time spanned by one bucket
+  long long current;              // slot of the last extracted event
+  double now;                     // time of the last extracted event
+  int *head;                      // earliest sphere of each bucket, -1 if empty
+  calendarnode *a;                // entry of each sphere
+
+  // width adaptation
+  int nupdates;                   // updates since the last check of the width
+  double lookahead;               // decaying sum of (time - now) over the updates
+  double weight;                  // decaying number of updates in lookahead
+
+  // functions which operate on the calendar
+
+  void insert(int i);
+  void update(int i);   // moves i to the bucket of s[i].nextevent.time
+  int extractmax();     // earliest sphere, not removed, like heap::extractmax
+  void refresh();       // reloads all times from s and relinks
+  void print();
+
+ private:
+  void link(int i);
+  void unlink(int i);
+  void resize(double width_i);   // relinks all spheres for a new width
+};
+
+#endif
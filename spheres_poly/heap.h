@@ -8,6 +8,20 @@
 #include "event.h"
 #include "sphere.h"
 
+#define HEAPARITY 4    // children per node, HEAPARITY nodes fill one cache line
+#define CACHELINE 64   // bytes
+
+//---------------------------------------------------------------------------
+// Heap entry: the event time is kept next to the sphere index, so the
+// comparisons in upheap and downheap never touch the sphere array
+//---------------------------------------------------------------------------
+class heapnode {
+
+ public:
+  double time;                    // time of the sphere's next event
+  int i;                          // sphere
+};
+
 class heap {
 
  public:
@@ -20,21 +34,26 @@ class heap {
   // variables
   int maxsize;   // max allowed number of events
   int N;         // current number of events
-  int *a;
+  heapnode *a;   // entries 1..N, the children of k are D(k-1)+2 .. Dk+1
+  heapnode *block;  // allocation holding a, padded so each family of children shares a cache line
   sphere *s;
   int *index;     // array of indices for each sphere
   //event minevent;
 
 
-  // functions which operate on a binary heap
+  // functions which operate on a d-ary heap
   
   void upheap(int k);
   void downheap(int k);
+  // both read the new time of the moved sphere from s once and store
+  // it in its entry
+  void update(int i);  // restores the heap after s[i].nextevent.time changed
   void insert(int i);
   void replace(int i);
   int search(int j);
   void change(int i); 
   int extractmax();
+  void refresh();  // reloads all times from s and rebuilds, after bulk changes
   void print();
   void checkindex();
   
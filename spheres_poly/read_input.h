@@ -1,6 +1,8 @@
 #ifndef READ_INPUT_H
 #define READ_INPUT_H
 
+#include <stdint.h>
+
 #define NAME_LEN 256
 
 
@@ -23,8 +25,11 @@ public:
   char readfile[NAME_LEN];    // file with configuration; if new, creates new
   char writefile[NAME_LEN];    // file to write configuration
   char datafile[NAME_LEN];       // file to write statistics
+  uint64_t seed;                  // seed of the random number generator, 0 draws one (optional)
+  int lammps;                     // 1 also writes the configuration as LAMMPS text (optional)
 
   int read(int argc, char* argv[]);
+  int option(const char* name, const char* value);
  
 };
 
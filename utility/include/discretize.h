@@ -2,6 +2,17 @@
 #define DISCRETIZE_H
 
 #include <string>
+#include <vector>
+
+#include "configuration.h"
+#include "mapped_file.h"
+#include "lammps_data.h"
+
+#ifdef _WIN32
+#define SPT "\\"		// path separator
+#else
+#define SPT "/"
+#endif
 
 class GridField
 {
@@ -37,13 +48,17 @@ public:
 	double get_section_pf(std::string dir, double dis, int res);
 
 private:
+	const configheader* map(const std::string& filename);
 	void get_field(const std::string& filename);
 	bool in_sphere(double x, double y, double z);
 
+	mapped_file file;		// a binary struct file, read where it lies
+	const configheader* header;	// at the start of file, 0 for a LAMMPS struct file
 	int num;
-	double radius;
-	int skip = 15;		// # of lines before coords in struct file
-	double** coords;
+	double radius;		// of every sphere, the largest one with radii
+	const double* coords;	// x, y, z of sphere id at coords + 3 * (id - 1)
+	const double* radii;	// radius of sphere id at radii[id - 1], 0 if all have radius
+	std::vector<double> parsed;	// coords of a LAMMPS struct file
 	GridField field;
 };
 
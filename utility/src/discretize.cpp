@@ -2,8 +2,11 @@
 #include <iostream>
 #include <unistd.h>		/* access */
 #include <cstdlib>		/* system */
+#include <cstring>		/* strncmp */
+#include <thread>		/* hardware_concurrency */
 
 #include "discretize.h"
+#include "stencil.h"
 
 /*****
 class GridField
@@ -86,37 +89,61 @@ class Box
 *****/
 
 Box::Box(const std::string& filename, int n, double r)
-: num(n), radius(r), field(n, r)
+: header(map(filename)), num(header ? header->N : n), radius(header ? header->radius : r),
+  coords(0), radii(0), field(num, radius)
 {
-	coords = new double*[num + 1];
-	for (int i = 0; i <= num; ++i)
-		coords[i] = new double[3];
-
 	get_field(filename);
 }
 
 Box::~Box()
 {
-	delete[] coords;
+}
+
+const configheader* Box::map(const std::string& filename)
+{
+	if (!file.open(filename.c_str()) || (file.size() < sizeof(configheader))
+		|| (strncmp(file.data(), CONFIGMAGIC, sizeof(configheader::magic)) != 0))
+		return 0;	// LAMMPS text, still mapped, or nothing
+	const configheader* h = (const configheader*)file.data();
+	if (!h->valid() || (h->dim != 3) || (file.size() != h->bytes()))
+	{
+		std::cout << "error, " << filename << " is a struct file of another version, dimension or machine" << std::endl;
+		exit(-1);
+	}
+	return h;
 }
 
 void Box::get_field(const std::string& filename)
 {
-	std::ifstream ifs(filename);
-	std::string line;
-	for (int i = 0; i < skip; ++i)
-		std::getline(ifs, line);
-	int id, type;
-	double x, y, z;
-	for (int i = 0; i < num; ++i)
+	if (header)
+	{
+		coords = header->x(file.data());
+		radii = header->radii(file.data());
+	}
+	else
 	{
-		ifs >> id >> type >> x >> y >> z;
-		coords[id][0] = x;
-		coords[id][1] = y;
-		coords[id][2] = z;
-		field.add_sphere(id, x, y, z);
+		// LAMMPS text, from its Atoms section on all cores
+		if (file.data() == 0)
+		{
+			std::cout << "error, can't open " << filename << std::endl;
+			exit(-1);
+		}
+		lammps_data text(file.data(), file.size());
+		parsed.resize(3 * num);
+		if ((text.natoms != num) || !text.read(3, parsed.data(), 0, std::thread::hardware_concurrency()))
+		{
+			std::cout << "error, " << filename << " is not a struct file of " << num << " spheres" << std::endl;
+			exit(-1);
+		}
+		file.close();
+		coords = parsed.data();
+	}
+
+	for (int id = 1; id <= num; ++id)
+	{
+		const double* c = coords + 3 * (id - 1);
+		field.add_sphere(id, c[0], c[1], c[2]);
 	}
-	ifs.close();
 }
 
 void SaveFile(const std::string& file, int* type, int dimX, int dimY, int dimZ)
@@ -149,7 +176,7 @@ void SaveFile(const std::string& file, int* type, int dimX, int dimY, int dimZ)
 	fclose(out);
 }
 
-double distance_square(double* curr, double* coor, double* pboffset)
+double distance_square(const double* curr, const double* coor, const double* pboffset)
 {
 	double res = 0;
 	for (int i = 0; i < 3; ++i)
@@ -162,54 +189,24 @@ double distance_square(double* curr, double* coor, double* pboffset)
 
 bool Box::in_sphere(double x, double y, double z)
 {
-    // now iterate through nearest neighbors
-    double delta = 1.0 / field.ngrid;
-    double curr[3] = {x, y, z};
-
-    bool flag = false;
-    double pboffset[3];        // nearest image offset
-    int grid[3] = {-1, -1, -1};
-    while (1)
-    {
-        for(int k = 0; k < 3; k++)
-        { 
-            if (curr[k] + grid[k] * delta < 0)              // out of bounds to left
-                pboffset[k] = -1;
-            else if (curr[k] + grid[k] * delta >= 1)   // out of bounds to right
-                pboffset[k] = 1;
-            else
-                pboffset[k] = 0;
-        }
-        int cellID = field.get_cell(x + grid[0] * delta + 1, y + grid[1] * delta + 1, z + grid[2] * delta + 1);
-        int j = field.cells[cellID];
-        while (j != -1)
-        {
-        	if (distance_square(curr, coords[j], pboffset) <= radius*radius)
-        	{
-        		flag = true;
-        		break;
-        	}
-            j = field.binlist[j];
-        }
-        if (flag)
-        {
-        	return true;
-        }
+	// a sphere containing the point has its centre in a nearest neighbour cell
+	double curr[3] = {x, y, z};
+	vector<3, int> cell;
+	for (int k = 0; k < 3; ++k)
+		cell[k] = int(curr[k] * field.ngrid);
 
-        // A. Donev:     
-        // This code makes this loop dimension-independent
-        // It is basically a flattened-out loop nest of depth DIM
-        // (-1, -1) (0, -1) (1, -1) (-1, 0) (0, 0) (1, 0) (-1, 1) (0, 1) (1, 1)
-        int ii;
-        for(ii = 0; ii < 3; ii++)
-        {
-            grid[ii] += 1;
-            if(grid[ii] <= 1) break;
-            grid[ii] = -1;
-        }
-        if(ii >= 3) break;
-    }
-    return false;
+	auto visit = [&](int cellID, const vector<3, int>& image)
+	{
+		double pboffset[3] = {double(image.x[0]), double(image.x[1]), double(image.x[2])};
+		for (int j = field.cells[cellID]; j != -1; j = field.binlist[j])
+		{
+			double r = radii ? radii[j - 1] : radius;
+			if (distance_square(curr, coords + 3 * (j - 1), pboffset) <= r*r)
+				return true;
+		}
+		return false;
+	};
+	return for_all_neighbor_cells(cell, field.ngrid, visit);
 }
 
 void Box::get_section(const std::string& filename, std::string dir, double dis, int res)